@@ -17,7 +17,7 @@
 \*************************************************************************************************/
 
 // Program constants
-const uint8_t NUM_PIXELS = 7;
+const uint8_t NUM_PIXELS = 7; // No more than 127 (twinkle offset is kept on 7 bits)
 const uint8_t MAX_BRIGHTNESS = 250;
 const uint8_t MIN_BRIGHTNESS = 0;
 const uint8_t SMALL_BRIGHTNESS_STEP = 10;
@@ -34,6 +34,18 @@ const uint16_t TIMER_MUSIC_COMPARE = (F_CPU / 256 / 1000 * MUSIC_CAPTURE_DELAY);
 const uint8_t CYCLE_FADE_VALUE = (255 / NUM_PIXELS);
 const uint16_t SENSORS_OVERFLOWS = 625; // number of overflows on timer2 with 1/1024 prescaler to count 10 sec
 
+// Power constants
+const uint16_t MAX_CURRENT_MA = 500; // Current budget for both strips (headliner fuse)
+const uint8_t LED_CHANNEL_MA = 20; // Current drawn by one colour channel at full value
+const uint8_t LED_IDLE_MA = 1; // Current drawn by one pixel driver while dark
+const uint8_t POWER_SCALE_UP_STEP = 5; // Brightness scale recovery per frame once under budget
+const uint8_t POWER_SCALE_NONE = 255; // Brightness scale for no limiting
+
+// Persistence constants
+const uint16_t SAVE_QUIET_PERIOD = 5000; // ms without changes before the state is written to EEPROM
+const uint8_t STATE_LOG_SLOTS = 64; // Records in the EEPROM ring (spreads wear over the slots)
+const uint8_t STATE_CHECKSUM_SEED = 0x5A; // Makes blank (0xFF) EEPROM fail the checksum
+
 // Color constants
 const uint16_t HUE_RED = 0;
 const uint16_t HUE_YELLOW = 1 * (MAX_HUE / 6);
@@ -44,6 +56,9 @@ const uint16_t HUE_MAGENTA = 5 * (MAX_HUE / 6);
 const uint16_t HUE_STEP = MAX_HUE / 10;
 const uint16_t HUE_TWINKLE_STEP = MAX_HUE / 500;
 
+// Random generator seed (any non zero value)
+const uint16_t RANDOM_SEED = 0xACE1;
+
 // Button decoded values
 const uint8_t IR_1 = 69;
 const uint8_t IR_2 = 70;
@@ -68,10 +83,10 @@ const uint8_t IR_DOWN = 82;
 \*************************************************************************************************/
 
 // LED states
-enum state {STATIC, TWINKLE, MUSIC, NOTHING};
+enum state : uint8_t {STATIC, TWINKLE, MUSIC, NOTHING};
 
 // Used for brightness and color changes
-enum direction {INCREASE, DECREASE};
+enum direction : uint8_t {INCREASE, DECREASE};
 
 /*************************************************************************************************\
  *                                        Data structures                                        *
@@ -83,29 +98,79 @@ typedef struct {
   uint8_t brightness;
   uint8_t brightness_save; // Helps restore previous value after music mode
   uint16_t hue;
-  bool selected; // Changes of color and brightness will only apply if true
-  bool rainbow; // Color cycling will only apply if true
-  bool twinkle; // Brightness cycling will only apply if true
+  bool selected : 1; // Changes of color and brightness will only apply if true
+  bool rainbow : 1; // Color cycling will only apply if true
+  bool twinkle : 1; // Brightness cycling will only apply if true
 } stripParams_t;
 
-// Structure used to keep runtime parameters of twinkle mode
+// Structure used to estimate the current drawn by one strip
+typedef struct {
+  uint16_t pixelLevel[NUM_PIXELS]; // Sum of R, G and B values of each pixel (before brightness)
+  uint16_t levelSum; // Sum of all pixel levels, updated on every pixel change
+} stripCurrent_t;
+
+// Structure used to keep runtime parameters of the current limiter
 typedef struct {
-  uint8_t twinkleLEDOffset; // Blacked out LED position during twinkle mode
-  bool twinkleChange; // Flag set in timer interrupt so the twinkle mode will advance
+  uint8_t scale; // Global brightness scale applied to both strips
+  uint8_t targetScale; // Scale needed to stay within the current budget
+  bool rescaled; // Set when the last frame changed the strips brightness (pixels were rescaled)
+} powerLimiter_t;
+
+// Structure used to save the parameters of one strip in EEPROM
+typedef struct {
+  uint16_t hue;
+  uint8_t saturation;
+  uint8_t brightness;
+  bool selected : 1;
+  bool rainbow : 1;
+  bool twinkle : 1;
+} savedStrip_t;
+
+// Record written in the EEPROM ring (sequence number is written last to commit the record)
+typedef struct {
+  uint8_t mode; // Light mode to restore (STATIC, TWINKLE or MUSIC)
+  savedStrip_t wide;
+  savedStrip_t narrow;
+  uint8_t checksum;
+  uint8_t seq;
+} savedState_t;
+
+// Structure used to keep runtime parameters of the EEPROM writer
+typedef struct {
+  savedState_t pending; // Record being written
+  uint8_t slot; // Slot of the latest record
+  uint8_t writePos; // Next byte of the pending record to write
+  bool writing; // Set while the pending record is being written
+  bool dirty; // Set when the state changed since the last save
+  uint32_t lastChange; // Time of the last change (ms)
+} stateStore_t;
+
+// Structure used to keep runtime parameters of twinkle mode (shares a byte with an ISR flag)
+typedef struct {
+  uint8_t twinkleLEDOffset : 7; // Blacked out LED position during twinkle mode
+  bool twinkleChange : 1; // Flag set in timer interrupt so the twinkle mode will advance
 } twinkleParams_t;
 
 // Structure used to keep runtime parameters of lightning mode
 typedef struct {
-  state prevMode; // Previous light mode
-  state currMode; // Current light mode
-  bool modeChange; // Flag set in interrupt routine so a new command will be decoded in loop
+  uint8_t prevMode : 2; // Previous light mode (state)
+  uint8_t currMode : 2; // Current light mode (state)
+  bool modeChange; // Flag set in interrupt routine so a new command will be decoded in loop (own byte)
 } lightMode_t;
 
-// Structure used to keep runtime parameters of front sensors and camera
+// Structure used to keep runtime parameters of front sensors and camera (shared with ISRs)
 typedef struct {
-  uint16_t currOverflows;
-  bool poweredOn;
-  bool signalPower;
+  uint16_t currOverflows : 14;
+  bool poweredOn : 1;
+  bool signalPower : 1;
 } sensorsParams_t;
 
+// Compact layout of the runtime state (AVR has no padding, host builds do)
+#ifdef __AVR__
+static_assert(sizeof(stripParams_t) == 6, "stripParams_t is no longer packed");
+static_assert(sizeof(twinkleParams_t) == 1, "twinkleParams_t is no longer packed");
+static_assert(sizeof(lightMode_t) == 2, "lightMode_t is no longer packed");
+static_assert(sizeof(sensorsParams_t) == 2, "sensorsParams_t is no longer packed");
+#endif
+
 #endif // _CONSTANTS_AND_TYPES_H
@@ -2,6 +2,7 @@
 #define _ISRS_TIMERS_ADC_H
 
 #include "ConstantsAndTypes.h"
+#include "LightMode.h"
 
 /*************************************************************************************************\
  *                                      Global Variables                                         *
@@ -35,7 +35,7 @@ ISR(TIMER2_OVF_vect) {
     // Time has passed -> turn sensors and timer off
     TIMSK2 &= ~(1 << TOIE2);
     sensorParams.signalPower = true;
-    Serial.println("TIMER 10 SEC");
+    Serial.println(F("TIMER 10 SEC"));
   }
 }
 
@@ -44,7 +44,7 @@ ISR(INT1_vect) {
   // Check if counting has already begun
   if (!(TIMSK2 & (1 << TOIE2))) {
     // Activate timer2 overflow interrupt
-    Serial.println("ACTIVATE TIMER2");
+    Serial.println(F("ACTIVATE TIMER2"));
     TIMSK2 |= (1 << TOIE2);
   }
 
@@ -52,7 +52,7 @@ ISR(INT1_vect) {
   sensorParams.currOverflows = 0;
   // Check if sensors need to be turned on
   sensorParams.signalPower = true;
-  Serial.println("REVERSE PIN INTERRUPT");
+  Serial.println(F("REVERSE PIN INTERRUPT"));
 }
 
 // Interrupt routine ADC
@@ -62,20 +62,20 @@ ISR(ADC_vect) {
 
   uint8_t brightnessNarrow_new = externNoise;
   // Add a random brightness increase
-  uint8_t brightnessWide_new = (externNoise + ((externNoise > 10) ? 10 + rand() % 30 : 0)) % MAX_BRIGHTNESS;
+  uint8_t brightnessWide_new = (externNoise + ((externNoise > 10) ? 10 + get_random_byte() % 30 : 0)) % MAX_BRIGHTNESS;
   
-  // Only change with 3 quarters of the difference for smoothness
+  // Only change with 3 quarters of the difference for smoothness (rounded as the float version did)
   if (brightnessNarrow_new > narrowStripParams.brightness) {
-    narrowStripParams.brightness = (uint8_t)(narrowStripParams.brightness + (brightnessNarrow_new - narrowStripParams.brightness) * 0.75) % MAX_BRIGHTNESS;
+    narrowStripParams.brightness = (uint8_t)(narrowStripParams.brightness + (brightnessNarrow_new - narrowStripParams.brightness) * 3 / 4) % MAX_BRIGHTNESS;
   } else {
-    narrowStripParams.brightness = (uint8_t)(narrowStripParams.brightness - (narrowStripParams.brightness - brightnessNarrow_new) * 0.75) % MAX_BRIGHTNESS;
+    narrowStripParams.brightness = (uint8_t)(narrowStripParams.brightness - ((narrowStripParams.brightness - brightnessNarrow_new) * 3 + 3) / 4) % MAX_BRIGHTNESS;
   }
 
-  // Only change with 3 quarters of the difference for smoothness
+  // Only change with 3 quarters of the difference for smoothness (rounded as the float version did)
   if (brightnessWide_new > wideStripParams.brightness) {
-    wideStripParams.brightness = (uint8_t)(wideStripParams.brightness + (brightnessWide_new - wideStripParams.brightness) * 0.75) % MAX_BRIGHTNESS;
+    wideStripParams.brightness = (uint8_t)(wideStripParams.brightness + (brightnessWide_new - wideStripParams.brightness) * 3 / 4) % MAX_BRIGHTNESS;
   } else {
-    wideStripParams.brightness = (uint8_t)(wideStripParams.brightness - (wideStripParams.brightness - brightnessWide_new) * 0.75) % MAX_BRIGHTNESS;
+    wideStripParams.brightness = (uint8_t)(wideStripParams.brightness - ((wideStripParams.brightness - brightnessWide_new) * 3 + 3) / 4) % MAX_BRIGHTNESS;
   }
 
   // Set flag to update brightness
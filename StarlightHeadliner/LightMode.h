@@ -2,7 +2,9 @@
 #define _LIGHT_MODE_H
 
 #include "ConstantsAndTypes.h"
+#include "PowerLimiter.h"
 #include <Adafruit_NeoPixel.h>
+#include <util/atomic.h>
 
 /*************************************************************************************************\
  *                                      Global Variables                                         *
@@ -22,6 +24,7 @@ extern lightMode_t lightMode;
 
 void stop_twinkle_timer();
 void start_twinkle_timer();
+uint8_t get_random_byte();
 uint16_t get_random_color();
 void change_brightness(direction dir);
 void change_color(direction dir);
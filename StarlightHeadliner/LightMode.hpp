@@ -29,9 +29,25 @@ void start_twinkle_timer() {
   sei();
 }
 
+// 16 bit xorshift (keeps rand() and its 32 bit arithmetic out of the build)
+uint8_t get_random_byte() {
+  static uint16_t xorshift = RANDOM_SEED;
+  uint8_t value;
+
+  // Also called from the ADC interrupt, the 16 bit update must not be split
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    xorshift ^= xorshift << 7;
+    xorshift ^= xorshift >> 9;
+    xorshift ^= xorshift << 8;
+    value = xorshift;
+  }
+
+  return value;
+}
+
 // Selects 1 out of 10 random colors
 uint16_t get_random_color() {
-  return (rand() % 10) * HUE_STEP;
+  return (get_random_byte() % 10) * HUE_STEP;
 }
 
 // Only affects the current selection of LEDs
@@ -107,41 +123,39 @@ void change_color(direction dir) {
 // Both LEDs will be static colored
 void static_mode() {
   // Clear previously selected values
-  pixelsWide.clear();
-  pixelsNarrow.clear();
-
-  // Set brightness
-  pixelsWide.setBrightness(wideStripParams.brightness);
-  pixelsNarrow.setBrightness(narrowStripParams.brightness);
+  clear_pixels(pixelsWide, wideStripCurrent);
+  clear_pixels(pixelsNarrow, narrowStripCurrent);
 
   // Set color (transform HSV spectrum to RGB)
   for (int i = 0; i < NUM_PIXELS; i++) {
-    pixelsWide.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation));
-    pixelsNarrow.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(narrowStripParams.hue, narrowStripParams.saturation));
+    set_pixel(pixelsWide, wideStripCurrent, i, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation));
+    set_pixel(pixelsNarrow, narrowStripCurrent, i, Adafruit_NeoPixel::ColorHSV(narrowStripParams.hue, narrowStripParams.saturation));
   }
 
+  // Set brightness (limited by the current budget)
+  apply_power_limit(wideStripParams.brightness, narrowStripParams.brightness);
+
   // Apply changes
   pixelsWide.show();
   pixelsNarrow.show();
 }
 
 void _execute_twinkle() {
-  // Update LEDs values
-  pixelsWide.setBrightness(wideStripParams.brightness);
-  pixelsNarrow.setBrightness(narrowStripParams.brightness);
-
   // Update each individual pixel values
   for (uint8_t i = 0; i < NUM_PIXELS; i++) {
     // Narrow strip is always cycling
-    pixelsNarrow.setPixelColor((i + twinkleParams.twinkleLEDOffset) % NUM_PIXELS, Adafruit_NeoPixel::ColorHSV(narrowStripParams.hue, narrowStripParams.saturation, pixelsNarrow.gamma8(i * (255 / NUM_PIXELS))));
+    set_pixel(pixelsNarrow, narrowStripCurrent, (i + twinkleParams.twinkleLEDOffset) % NUM_PIXELS, Adafruit_NeoPixel::ColorHSV(narrowStripParams.hue, narrowStripParams.saturation, pixelsNarrow.gamma8(i * (255 / NUM_PIXELS))));
     // Wide strip might be static
     if (wideStripParams.twinkle) {
-      pixelsWide.setPixelColor((i + twinkleParams.twinkleLEDOffset) % NUM_PIXELS, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation, pixelsWide.gamma8(i * (255 / NUM_PIXELS))));
+      set_pixel(pixelsWide, wideStripCurrent, (i + twinkleParams.twinkleLEDOffset) % NUM_PIXELS, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation, pixelsWide.gamma8(i * (255 / NUM_PIXELS))));
     } else {
-      pixelsWide.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation));
+      set_pixel(pixelsWide, wideStripCurrent, i, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation));
     }
   }
 
+  // Update LEDs values (brightness limited by the current budget)
+  apply_power_limit(wideStripParams.brightness, narrowStripParams.brightness);
+
   // Apply changes
   pixelsWide.show();
   pixelsNarrow.show();
@@ -161,9 +175,12 @@ void _execute_twinkle() {
 void twinkle_mode() {
   // Interrupt signaled it's time to update the twinkle effect
   if (twinkleParams.twinkleChange) {
+    // Flag shares its byte with the offset, so the timer interrupt must not fire in between
+    cli();
     twinkleParams.twinkleChange = false;
     // Increase blacked out LED position on ring
     twinkleParams.twinkleLEDOffset = (twinkleParams.twinkleLEDOffset + 1) % NUM_PIXELS;
+    sei();
     _execute_twinkle();
   }
 }
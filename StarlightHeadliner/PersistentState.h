@@ -0,0 +1,30 @@
+#ifndef _PERSISTENT_STATE_H
+#define _PERSISTENT_STATE_H
+
+#include "ConstantsAndTypes.h"
+#include <avr/eeprom.h>
+
+static_assert(STATE_LOG_SLOTS * sizeof(savedState_t) <= E2END + 1, "State log does not fit in EEPROM");
+
+/*************************************************************************************************\
+ *                                      Global Variables                                         *
+\*************************************************************************************************/
+
+extern volatile stripParams_t wideStripParams;
+extern volatile stripParams_t narrowStripParams;
+extern lightMode_t lightMode;
+extern stateStore_t stateStore;
+
+/*************************************************************************************************\
+ *                                     Function prototypes                                       *
+\*************************************************************************************************/
+
+uint8_t _state_checksum(const savedState_t &record);
+uint8_t *_slot_address(uint8_t slot);
+void _save_strip(savedStrip_t &saved, volatile stripParams_t &params, bool music);
+void _restore_strip(const savedStrip_t &saved, volatile stripParams_t &params);
+bool restore_state();
+void mark_state_changed();
+void save_state_step();
+
+#endif // _PERSISTENT_STATE_H
@@ -0,0 +1,140 @@
+#ifndef _PERSISTENT_STATE_HPP
+#define _PERSISTENT_STATE_HPP
+
+#include "PersistentState.h"
+
+/*************************************************************************************************\
+ *                                Functions for saving the state                                 *
+\*************************************************************************************************/
+
+// Sum of the record bytes before the checksum
+uint8_t _state_checksum(const savedState_t &record) {
+  const uint8_t *bytes = (const uint8_t *)&record;
+  uint8_t sum = STATE_CHECKSUM_SEED;
+
+  for (uint8_t i = 0; i < offsetof(savedState_t, checksum); i++) {
+    sum += bytes[i];
+  }
+
+  return sum;
+}
+
+// EEPROM address of a record in the ring
+uint8_t *_slot_address(uint8_t slot) {
+  return (uint8_t *)(slot * sizeof(savedState_t));
+}
+
+// Copies the strip parameters (music mode saves the brightness it will restore)
+void _save_strip(savedStrip_t &saved, volatile stripParams_t &params, bool music) {
+  saved.hue = params.hue;
+  saved.saturation = params.saturation;
+  saved.brightness = music ? params.brightness_save : params.brightness;
+  saved.selected = params.selected;
+  saved.rainbow = params.rainbow;
+  saved.twinkle = params.twinkle;
+}
+
+void _restore_strip(const savedStrip_t &saved, volatile stripParams_t &params) {
+  params.hue = saved.hue;
+  params.saturation = saved.saturation;
+  params.brightness = saved.brightness;
+  params.selected = saved.selected;
+  params.rainbow = saved.rainbow;
+  params.twinkle = saved.twinkle;
+}
+
+// Loads the latest valid record from the ring, returns false if there is none
+bool restore_state() {
+  savedState_t record;
+
+  // Latest record is the last one before a break in the sequence numbers
+  uint8_t seq = eeprom_read_byte(_slot_address(0) + offsetof(savedState_t, seq));
+  uint8_t slot = 0;
+
+  while (slot < STATE_LOG_SLOTS - 1) {
+    uint8_t nextSeq = eeprom_read_byte(_slot_address(slot + 1) + offsetof(savedState_t, seq));
+
+    if (nextSeq != (uint8_t)(seq + 1)) {
+      break;
+    }
+
+    seq = nextSeq;
+    slot++;
+  }
+
+  // Next record goes after the latest one
+  stateStore.slot = slot;
+  stateStore.pending.seq = seq;
+  stateStore.writing = false;
+  stateStore.dirty = false;
+
+  eeprom_read_block(&record, _slot_address(slot), sizeof(savedState_t));
+
+  if (record.checksum != _state_checksum(record) || record.mode > MUSIC) {
+    return false;
+  }
+
+  _restore_strip(record.wide, wideStripParams);
+  _restore_strip(record.narrow, narrowStripParams);
+  lightMode.currMode = record.mode;
+
+  return true;
+}
+
+// Delays saving until no changes are made for SAVE_QUIET_PERIOD
+void mark_state_changed() {
+  stateStore.dirty = true;
+  stateStore.lastChange = millis();
+}
+
+// Writes at most one EEPROM byte, only when the previous write has finished (never blocks)
+void save_state_step() {
+  if (stateStore.writing) {
+    if (!eeprom_is_ready()) {
+      return;
+    }
+
+    eeprom_update_byte(_slot_address(stateStore.slot) + stateStore.writePos, ((uint8_t *)&stateStore.pending)[stateStore.writePos]);
+
+    if (++stateStore.writePos == sizeof(savedState_t)) {
+      stateStore.writing = false;
+    }
+
+    return;
+  }
+
+  if (!stateStore.dirty || millis() - stateStore.lastChange < SAVE_QUIET_PERIOD) {
+    return;
+  }
+
+  stateStore.dirty = false;
+
+  // Blank state is saved as static so it will be applied after restore
+  bool music = lightMode.currMode == MUSIC;
+  stateStore.pending.mode = (lightMode.currMode == NOTHING) ? STATIC : lightMode.currMode;
+  _save_strip(stateStore.pending.wide, wideStripParams, music);
+  _save_strip(stateStore.pending.narrow, narrowStripParams, music);
+  stateStore.pending.checksum = _state_checksum(stateStore.pending);
+
+  // Skip the write if the latest record holds the same values
+  bool changed = false;
+
+  for (uint8_t i = 0; i < offsetof(savedState_t, seq); i++) {
+    if (eeprom_read_byte(_slot_address(stateStore.slot) + i) != ((uint8_t *)&stateStore.pending)[i]) {
+      changed = true;
+      break;
+    }
+  }
+
+  if (!changed) {
+    return;
+  }
+
+  // Move to the next slot of the ring
+  stateStore.slot = (stateStore.slot + 1) % STATE_LOG_SLOTS;
+  stateStore.pending.seq++;
+  stateStore.writePos = 0;
+  stateStore.writing = true;
+}
+
+#endif // _PERSISTENT_STATE_HPP
@@ -0,0 +1,32 @@
+#ifndef _POWER_LIMITER_H
+#define _POWER_LIMITER_H
+
+#include "ConstantsAndTypes.h"
+#include <Adafruit_NeoPixel.h>
+
+// Pixel levels are summed on 16 bits (3 * 255 per pixel)
+static_assert(NUM_PIXELS <= 85, "stripCurrent_t.levelSum would overflow");
+
+/*************************************************************************************************\
+ *                                      Global Variables                                         *
+\*************************************************************************************************/
+
+extern Adafruit_NeoPixel pixelsWide;
+extern Adafruit_NeoPixel pixelsNarrow;
+
+extern stripCurrent_t wideStripCurrent;
+extern stripCurrent_t narrowStripCurrent;
+extern powerLimiter_t powerLimiter;
+
+/*************************************************************************************************\
+ *                                     Function prototypes                                       *
+\*************************************************************************************************/
+
+void setup_power_limiter();
+void clear_pixels(Adafruit_NeoPixel &pixels, stripCurrent_t &current);
+void set_pixel(Adafruit_NeoPixel &pixels, stripCurrent_t &current, uint8_t pos, uint32_t color);
+uint16_t estimate_current(const stripCurrent_t &current, uint8_t brightness);
+void apply_power_limit(uint8_t brightnessWide, uint8_t brightnessNarrow);
+bool power_limit_settled();
+
+#endif // _POWER_LIMITER_H
@@ -0,0 +1,94 @@
+#ifndef _POWER_LIMITER_HPP
+#define _POWER_LIMITER_HPP
+
+#include "PowerLimiter.h"
+
+/*************************************************************************************************\
+ *                                Functions for current limiting                                 *
+\*************************************************************************************************/
+
+// Starts without limiting and with dark strips
+void setup_power_limiter() {
+  powerLimiter.scale = POWER_SCALE_NONE;
+  powerLimiter.targetScale = POWER_SCALE_NONE;
+  powerLimiter.rescaled = false;
+
+  pixelsWide.setBrightness(POWER_SCALE_NONE);
+  pixelsNarrow.setBrightness(POWER_SCALE_NONE);
+
+  clear_pixels(pixelsWide, wideStripCurrent);
+  clear_pixels(pixelsNarrow, narrowStripCurrent);
+}
+
+// Turns off every pixel of the strip and resets its current estimate
+void clear_pixels(Adafruit_NeoPixel &pixels, stripCurrent_t &current) {
+  pixels.clear();
+
+  for (uint8_t i = 0; i < NUM_PIXELS; i++) {
+    current.pixelLevel[i] = 0;
+  }
+  current.levelSum = 0;
+}
+
+// Sets a pixel color and updates the strip current estimate with the difference
+void set_pixel(Adafruit_NeoPixel &pixels, stripCurrent_t &current, uint8_t pos, uint32_t color) {
+  uint16_t level = (uint16_t)(uint8_t)(color >> 16) + (uint8_t)(color >> 8) + (uint8_t)color;
+
+  current.levelSum = current.levelSum - current.pixelLevel[pos] + level;
+  current.pixelLevel[pos] = level;
+
+  pixels.setPixelColor(pos, color);
+}
+
+// Current (mA) drawn by a strip at the given brightness (NeoPixel scales channels by brightness + 1)
+uint16_t estimate_current(const stripCurrent_t &current, uint8_t brightness) {
+  uint32_t scaledLevel = (uint32_t)current.levelSum * (brightness + 1);
+
+  return NUM_PIXELS * LED_IDLE_MA + scaledLevel * LED_CHANNEL_MA / (256UL * 255);
+}
+
+// Scales both strips brightness so the estimated current stays within MAX_CURRENT_MA
+// (called once the frame pixels are set, right before show(); pixel levels do not depend on brightness)
+void apply_power_limit(uint8_t brightnessWide, uint8_t brightnessNarrow) {
+  uint16_t idleCurrent = 2 * NUM_PIXELS * LED_IDLE_MA;
+  uint16_t activeCurrent = estimate_current(wideStripCurrent, brightnessWide) +
+                            estimate_current(narrowStripCurrent, brightnessNarrow) - idleCurrent;
+
+  // Find the scale that would bring the strips back under budget
+  if (idleCurrent + activeCurrent <= MAX_CURRENT_MA) {
+    powerLimiter.targetScale = POWER_SCALE_NONE;
+  } else {
+    powerLimiter.targetScale = (uint32_t)(MAX_CURRENT_MA - idleCurrent) * POWER_SCALE_NONE / activeCurrent;
+  }
+
+  // Drop by half the difference each frame, recover with small steps for smoothness
+  if (powerLimiter.scale > powerLimiter.targetScale) {
+    powerLimiter.scale -= max((powerLimiter.scale - powerLimiter.targetScale) / 2, 1);
+  } else if (powerLimiter.scale < powerLimiter.targetScale) {
+    powerLimiter.scale = min(powerLimiter.scale + POWER_SCALE_UP_STEP, powerLimiter.targetScale);
+  }
+
+  uint8_t scaledWide = (uint16_t)brightnessWide * (powerLimiter.scale + 1) >> 8;
+  uint8_t scaledNarrow = (uint16_t)brightnessNarrow * (powerLimiter.scale + 1) >> 8;
+
+  // Changing brightness rescales the whole strip buffer, so it is only done when needed
+  powerLimiter.rescaled = false;
+
+  if (pixelsWide.getBrightness() != scaledWide) {
+    pixelsWide.setBrightness(scaledWide);
+    powerLimiter.rescaled = true;
+  }
+
+  if (pixelsNarrow.getBrightness() != scaledNarrow) {
+    pixelsNarrow.setBrightness(scaledNarrow);
+    powerLimiter.rescaled = true;
+  }
+}
+
+// True once the brightness scale has reached the one required by the budget
+// and the last frame was written at its final brightness (a rescale is lossy)
+bool power_limit_settled() {
+  return powerLimiter.scale == powerLimiter.targetScale && !powerLimiter.rescaled;
+}
+
+#endif // _POWER_LIMITER_HPP
@@ -4,6 +4,8 @@
 
 #include "ConstantsAndTypes.h"
 #include "MusicMode.hpp"
+#include "PowerLimiter.hpp"
+#include "PersistentState.hpp"
 #include "LightMode.hpp"
 #include "ISRsTimersADC.hpp"
 #include "adaptedTinyIRReceiver.hpp"
@@ -21,6 +23,14 @@ Adafruit_NeoPixel pixelsNarrow(NUM_PIXELS, NARROW_PIN, NEO_GRB + NEO_KHZ800);
 volatile stripParams_t wideStripParams;
 volatile stripParams_t narrowStripParams;
 
+// Neopixels current estimates
+stripCurrent_t wideStripCurrent;
+stripCurrent_t narrowStripCurrent;
+powerLimiter_t powerLimiter;
+
+// Saved state (EEPROM)
+stateStore_t stateStore;
+
 // Program values
 volatile twinkleParams_t twinkleParams;
 volatile sensorsParams_t sensorParams;
@@ -56,6 +66,7 @@ void setup() {
   // Neopixels startup
   pixelsWide.begin();
   pixelsNarrow.begin();
+  setup_power_limiter();
 
   // Play animation
   startup_animation();
@@ -73,13 +84,18 @@ void loop() {
   }
 
   if (sensorParams.signalPower) {
-    // Clear flag
+    // Clear flag (shares its bytes with interrupt written fields)
+    cli();
     sensorParams.signalPower = false;
+    sei();
     handle_sensors();
   }
 
   // Update LEDs based on selected light mode
   execute_mode();
+
+  // Save changes to EEPROM once the user stops changing them
+  save_state_step();
 }
 
 /*************************************************************************************************\
@@ -101,19 +117,30 @@ void set_initial_values() {
   wideStripParams.twinkle = false;
   narrowStripParams.twinkle = false;
 
-  // Sensors params
+  // Sensors and twinkle params share their bytes with interrupt written fields
+  cli();
   sensorParams.currOverflows = 0;
   sensorParams.poweredOn = false;
   sensorParams.signalPower = false;
+  twinkleParams.twinkleLEDOffset = 0;
+  twinkleParams.twinkleChange = false;
+  sei();
 
   // Program params (starts on white-red twinkle)
   command = IR_7;
   lightMode.currMode = TWINKLE;
   lightMode.prevMode = TWINKLE;
-  twinkleParams.twinkleLEDOffset = 0;
-  twinkleParams.twinkleChange = false;
   lightMode.modeChange = true; // Force set flag to execute default command
   brightnessChanged = false;
+
+  // Saved state replaces the default command
+  if (restore_state()) {
+    // Timer1 channel A is already running, as if coming from twinkle mode
+    lightMode.prevMode = TWINKLE;
+    lightMode.modeChange = false;
+    update_timer_status();
+    update_ADC_status();
+  }
 }
 
 /*************************************************************************************************\
@@ -122,11 +149,13 @@ void set_initial_values() {
 
 // Applies changes to the LEDs
 void execute_mode() {
-  switch (lightMode.currMode) {
+  switch ((state)lightMode.currMode) {
     case STATIC:
       static_mode();
-      // Change mode to blank state after applying changes
-      lightMode.currMode = NOTHING;
+      // Change mode to blank state after applying changes (and brightness limiting)
+      if (power_limit_settled()) {
+        lightMode.currMode = NOTHING;
+      }
       break;
     
     case TWINKLE:
@@ -134,8 +163,8 @@ void execute_mode() {
       break;
 
     case MUSIC:
-      // Flag set at the end of ADC conversion
-      if (brightnessChanged) {
+      // Flag set at the end of ADC conversion (or brightness still being limited)
+      if (brightnessChanged || !power_limit_settled()) {
         // Update brightness and clear flag
         brightnessChanged = false;
         static_mode();
@@ -356,12 +385,17 @@ void decode_command() {
   // Timer and ADC checks for current mode configuration
   update_timer_status();
   update_ADC_status();
+
+  // Save the new configuration after a quiet period
+  mark_state_changed();
 }
 
 // Signals front sensors to turn on or off
 void _changeSensorsPower() {
-  // Change power state
+  // Change power state (shares its bytes with interrupt written fields)
+  cli();
   sensorParams.poweredOn = !sensorParams.poweredOn;
+  sei();
 
   // Send power impulse
   PORTD |= (1 << SENSORS_TRIGGER_PIN);
@@ -375,18 +409,20 @@ void handle_sensors() {
   // Time passed -> stop timer and turn off sensors
   if (sensorParams.currOverflows >= SENSORS_OVERFLOWS) {
     if (sensorParams.poweredOn) {
-      Serial.println("TURN OFF SENSORS");
+      Serial.println(F("TURN OFF SENSORS"));
       _changeSensorsPower();
     }
 
+    cli();
     sensorParams.currOverflows = 0;
+    sei();
 
     return;
   }
 
   // Time has not passed yet -> check if sensors should turn on
   if (!sensorParams.poweredOn) {
-      Serial.println("TURN ON SENSORS");
+      Serial.println(F("TURN ON SENSORS"));
       _changeSensorsPower();
     }
 }
@@ -398,14 +434,16 @@ void startup_animation() {
   narrowStripParams.saturation = SATURATION_WHITE;
   narrowStripParams.hue = MAX_HUE;
 
-  // Set brightness
-  pixelsWide.setBrightness(MAX_BRIGHTNESS);
-  pixelsNarrow.setBrightness(MAX_BRIGHTNESS);
-
   // Light up from front to back
   for (int i = 0; i < NUM_PIXELS; i++) {
-    pixelsWide.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation));
-    pixelsNarrow.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(narrowStripParams.hue, narrowStripParams.saturation));
+    // Every lit pixel is set again (the ones after i stay dark)
+    for (int j = 0; j <= i; j++) {
+      set_pixel(pixelsWide, wideStripCurrent, j, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation));
+      set_pixel(pixelsNarrow, narrowStripCurrent, j, Adafruit_NeoPixel::ColorHSV(narrowStripParams.hue, narrowStripParams.saturation));
+    }
+
+    // Set brightness (limited by the current budget)
+    apply_power_limit(MAX_BRIGHTNESS, MAX_BRIGHTNESS);
 
     // Apply changes
     pixelsWide.show();
@@ -415,9 +453,17 @@ void startup_animation() {
 
   // Clear light from front to back
   for (int i = 0; i < NUM_PIXELS; i++) {
-    // Pass 0 to value of HSV in order to turn off LED
-    pixelsWide.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation, 0));
-    pixelsNarrow.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(narrowStripParams.hue, narrowStripParams.saturation, 0));
+    // Every pixel is set again
+    for (int j = 0; j < NUM_PIXELS; j++) {
+      // Pass 0 to value of HSV in order to turn off LED
+      uint8_t value = (j <= i) ? VALUE_BLACK : VALUE_COLOR;
+
+      set_pixel(pixelsWide, wideStripCurrent, j, Adafruit_NeoPixel::ColorHSV(wideStripParams.hue, wideStripParams.saturation, value));
+      set_pixel(pixelsNarrow, narrowStripCurrent, j, Adafruit_NeoPixel::ColorHSV(narrowStripParams.hue, narrowStripParams.saturation, value));
+    }
+
+    // Set brightness (limited by the current budget)
+    apply_power_limit(MAX_BRIGHTNESS, MAX_BRIGHTNESS);
 
     // Apply changes
     pixelsWide.show();
@@ -0,0 +1,352 @@
+// Deterministic per-frame cost of every light mode
+//
+// Each measured call is single-stepped by a tracing parent process, so the logic cost is the exact number
+// of host instructions executed (no timer, interrupt or show() latch wait noise). show() is stubbed on the
+// host, its AVR cost is modeled instead: the bit-banged output takes 20 cycles (1.25 us at 16 MHz) for
+// each of the 24 bits of every pixel, with interrupts off. Both are compared against a CSV baseline and the
+// run fails when one grows by more than TOLERANCE_PERCENT.
+//
+//   bench_frames BASELINE.csv            compare against the baseline
+//   bench_frames --update BASELINE.csv   write the current counts as the new baseline
+//
+// Instruction counts depend on the host compiler. The baseline records it, and instructions are not
+// compared when it differs (only the show() cycles are), regenerate the baseline after a toolchain change.
+// The tracer reads x86-64 registers through Linux ptrace, other hosts skip the benchmark.
+#include <stdio.h>
+
+#if defined(__linux__) && defined(__x86_64__)
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ptrace.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+
+#include "ConstantsAndTypes.h"
+#include "PowerLimiter.h"
+#include "LightMode.h"
+#include "ISRsTimersADC.h"
+
+void set_initial_values();
+void decode_command();
+void execute_mode();
+
+const uint8_t FRAMES = 4; // Frames averaged for each scenario (counts only vary with the pixel data)
+const uint8_t TOLERANCE_PERCENT = 10;
+const uint8_t MAX_RESULTS = 64;
+const uint8_t SHOW_BITS_PER_PIXEL = 24;
+const uint8_t SHOW_CYCLES_PER_BIT = 20;
+
+#ifdef __clang__
+const char COMPILER[] = "clang " __VERSION__;
+#else
+const char COMPILER[] = "gcc " __VERSION__;
+#endif
+
+typedef struct {
+  const char *name;
+  uint8_t command;
+} scenario_t;
+
+// Played in order, so music mode is entered and left like on the board
+const scenario_t SCENARIOS[] = {
+  {"static_white", IR_1},
+  {"static_red", IR_2},
+  {"static_random", IR_3},
+  {"music", IR_OK},
+  {"twinkle_white", IR_4},
+  {"twinkle_red", IR_5},
+  {"twinkle_rainbow", IR_6},
+  {"twinkle_narrow_static_red", IR_7},
+  {"twinkle_narrow_static_random", IR_8},
+  {"twinkle_narrow_rainbow", IR_9},
+  {"brightness_down", IR_DOWN},
+  {"color_right", IR_RIGHT},
+};
+
+typedef struct {
+  char key[256];
+  unsigned long instructions;
+  unsigned long showCycles;
+} result_t;
+
+// Written by the tracing parent when a measured call returns
+volatile unsigned long tracedInstructions;
+
+// The parent stops counting when the child reaches this function
+extern "C" __attribute__((noinline)) void bench_region_end() {
+  asm volatile("");
+}
+
+unsigned long count_instructions(void (*call)()) {
+  asm volatile("int3");
+  call();
+  bench_region_end();
+
+  return tracedInstructions;
+}
+
+// Shows sent to both strips so far
+unsigned long count_shows() {
+  return pixelsWide.getShowCount() + pixelsNarrow.getShowCount();
+}
+
+// Modeled AVR cycles spent in show() for the given number of strip updates
+unsigned long show_cycles(unsigned long shows) {
+  return shows * NUM_PIXELS * SHOW_BITS_PER_PIXEL * SHOW_CYCLES_PER_BIT;
+}
+
+// One frame of the current mode, without waiting for its timer or the ADC
+void bench_frame() {
+  switch ((state)lightMode.currMode) {
+    case TWINKLE:
+      twinkleParams.twinkleChange = true;
+      break;
+
+    case MUSIC:
+      brightnessChanged = true;
+      break;
+
+    default:
+      // Static mode turns into blank state after each frame
+      lightMode.currMode = STATIC;
+      break;
+  }
+
+  execute_mode();
+}
+
+void run_scenarios(FILE *out) {
+  setup_power_limiter();
+  set_initial_values();
+
+  for (const scenario_t &scenario : SCENARIOS) {
+    command = scenario.command;
+    unsigned long shows = count_shows();
+    unsigned long instructions = count_instructions(decode_command);
+    fprintf(out, "%s,decode_command,%lu,%lu\n", scenario.name, instructions, show_cycles(count_shows() - shows));
+
+    // First frame fills lookup tables and resolves library calls
+    bench_frame();
+
+    shows = count_shows();
+    instructions = 0;
+    for (uint8_t i = 0; i < FRAMES; i++) {
+      instructions += count_instructions(bench_frame);
+    }
+    fprintf(out, "%s,execute_mode,%lu,%lu\n", scenario.name, instructions / FRAMES,
+            show_cycles(count_shows() - shows) / FRAMES);
+  }
+}
+
+// Single-steps the child from each int3 to bench_region_end() and hands back the count
+bool trace_child(pid_t child) {
+  int status;
+
+  waitpid(child, &status, 0);
+  ptrace(PTRACE_CONT, child, 0, 0);
+
+  while (true) {
+    waitpid(child, &status, 0);
+
+    if (WIFEXITED(status)) {
+      return WEXITSTATUS(status) == 0;
+    }
+
+    if (!WIFSTOPPED(status) || WSTOPSIG(status) != SIGTRAP) {
+      fprintf(stderr, "benchmark process stopped unexpectedly\n");
+      kill(child, SIGKILL);
+      return false;
+    }
+
+    unsigned long count = 0;
+
+    while (true) {
+      struct user_regs_struct regs;
+
+      if (ptrace(PTRACE_SINGLESTEP, child, 0, 0) != 0) {
+        return false;
+      }
+      waitpid(child, &status, 0);
+      ptrace(PTRACE_GETREGS, child, 0, &regs);
+
+      if (regs.rip == (uintptr_t)&bench_region_end) {
+        break;
+      }
+      count++;
+    }
+
+    ptrace(PTRACE_POKEDATA, child, (void *)&tracedInstructions, (void *)count);
+    ptrace(PTRACE_CONT, child, 0, 0);
+  }
+}
+
+// Reads "scenario,function,instructions,show_cycles" lines (and the compiler comment when asked for)
+uint8_t read_results(FILE *in, result_t *results, char *compiler, size_t compilerSize) {
+  const char COMPILER_PREFIX[] = "# compiler: ";
+  char line[256];
+  uint8_t count = 0;
+
+  while (fgets(line, sizeof(line), in) && count < MAX_RESULTS) {
+    line[strcspn(line, "\n")] = '\0';
+
+    if (compiler && strncmp(line, COMPILER_PREFIX, strlen(COMPILER_PREFIX)) == 0) {
+      snprintf(compiler, compilerSize, "%s", line + strlen(COMPILER_PREFIX));
+      continue;
+    }
+
+    char *cycles = strrchr(line, ',');
+
+    if (line[0] == '#' || !cycles) {
+      continue;
+    }
+    *cycles = '\0';
+
+    char *instructions = strrchr(line, ',');
+
+    if (!instructions) {
+      continue;
+    }
+    *instructions = '\0';
+
+    snprintf(results[count].key, sizeof(results[count].key), "%s", line);
+    results[count].instructions = strtoul(instructions + 1, NULL, 10);
+    results[count].showCycles = strtoul(cycles + 1, NULL, 10);
+    count++;
+  }
+
+  return count;
+}
+
+// 1 when the value grew past the tolerance, -1 when it dropped past it, 0 otherwise
+int8_t compare_cost(unsigned long current, unsigned long expected) {
+  if (current * 100 > expected * (100 + TOLERANCE_PERCENT)) {
+    return 1;
+  }
+
+  if (current * 100 < expected * (100 - TOLERANCE_PERCENT)) {
+    return -1;
+  }
+
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  bool update = argc == 3 && strcmp(argv[1], "--update") == 0;
+
+  if (argc != 2 && !update) {
+    fprintf(stderr, "usage: %s [--update] BASELINE.csv\n", argv[0]);
+    return 2;
+  }
+
+  const char *baselinePath = argv[argc - 1];
+  FILE *measured = tmpfile();
+
+  pid_t child = fork();
+
+  if (child == 0) {
+    ptrace(PTRACE_TRACEME, 0, 0, 0);
+    raise(SIGSTOP);
+    run_scenarios(measured);
+    fflush(measured);
+    _exit(0);
+  }
+
+  if (!trace_child(child)) {
+    fprintf(stderr, "tracing failed (ptrace must be allowed)\n");
+    return 2;
+  }
+
+  result_t current[MAX_RESULTS];
+  rewind(measured);
+  uint8_t currentCount = read_results(measured, current, NULL, 0);
+
+  if (update) {
+    FILE *out = fopen(baselinePath, "w");
+
+    if (!out) {
+      perror(baselinePath);
+      return 2;
+    }
+
+    fprintf(out, "# Host instructions and modeled AVR show() cycles per call, written by bench_frames --update\n");
+    fprintf(out, "# compiler: %s\n", COMPILER);
+    fprintf(out, "# scenario,function,host_instructions,avr_show_cycles\n");
+    for (uint8_t i = 0; i < currentCount; i++) {
+      fprintf(out, "%s,%lu,%lu\n", current[i].key, current[i].instructions, current[i].showCycles);
+    }
+    fclose(out);
+    printf("Baseline written to %s\n", baselinePath);
+
+    return 0;
+  }
+
+  FILE *in = fopen(baselinePath, "r");
+
+  if (!in) {
+    perror(baselinePath);
+    return 2;
+  }
+
+  result_t baseline[MAX_RESULTS];
+  char baselineCompiler[256] = "unknown";
+  uint8_t baselineCount = read_results(in, baseline, baselineCompiler, sizeof(baselineCompiler));
+  fclose(in);
+
+  // Instruction counts from another compiler say nothing about the code, only show() cycles are compared then
+  bool sameCompiler = strcmp(baselineCompiler, COMPILER) == 0;
+  bool passed = true;
+
+  if (!sameCompiler) {
+    printf("Baseline compiler (%s) differs from this one (%s), host instructions are not compared\n",
+           baselineCompiler, COMPILER);
+  }
+
+  printf("scenario,function,host_instructions,baseline,avr_show_cycles,baseline,result\n");
+
+  for (uint8_t i = 0; i < currentCount; i++) {
+    const result_t *expected = NULL;
+
+    for (uint8_t j = 0; j < baselineCount; j++) {
+      if (strcmp(baseline[j].key, current[i].key) == 0) {
+        expected = &baseline[j];
+      }
+    }
+
+    const char *result = "OK";
+
+    if (!expected) {
+      result = "MISSING";
+      passed = false;
+    } else {
+      int8_t showChange = compare_cost(current[i].showCycles, expected->showCycles);
+      int8_t logicChange = sameCompiler ? compare_cost(current[i].instructions, expected->instructions) : 0;
+
+      if (showChange > 0 || logicChange > 0) {
+        result = "REGRESSION";
+        passed = false;
+      } else if (showChange < 0 || logicChange < 0) {
+        result = "IMPROVED";
+      }
+    }
+
+    printf("%s,%lu,%lu,%lu,%lu,%s\n", current[i].key, current[i].instructions, expected ? expected->instructions : 0,
+           current[i].showCycles, expected ? expected->showCycles : 0, result);
+  }
+
+  printf("%s\n", passed ? "BENCHMARK PASSED" : "BENCHMARK FAILED");
+
+  return passed ? 0 : 1;
+}
+
+#else
+
+int main() {
+  printf("Benchmark skipped (instruction tracing needs x86-64 Linux)\n");
+
+  return 0;
+}
+
+#endif
@@ -0,0 +1,121 @@
+// Host build stand-in for Adafruit_NeoPixel
+// Keeps the library's pixel buffer and brightness scaling, show() only counts calls (no latch wait)
+// and buffer rescales are counted so tests can check the cost of a frame
+#ifndef _ADAFRUIT_NEOPIXEL_STUB_H
+#define _ADAFRUIT_NEOPIXEL_STUB_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+  Adafruit_NeoPixel(uint16_t n, int16_t, uint16_t) : numLEDs(n), brightness(0), shows(0), rescales(0) {
+    pixels = new uint8_t[3 * n]();
+  }
+
+  void begin() {}
+  void show() { shows++; }
+  void clear() { memset(pixels, 0, 3 * numLEDs); }
+
+  void setPixelColor(uint16_t n, uint32_t c) {
+    uint8_t r = c >> 16, g = c >> 8, b = c;
+
+    if (brightness) {
+      r = (r * brightness) >> 8;
+      g = (g * brightness) >> 8;
+      b = (b * brightness) >> 8;
+    }
+
+    pixels[3 * n] = r;
+    pixels[3 * n + 1] = g;
+    pixels[3 * n + 2] = b;
+  }
+
+  // Same lossy rescale of the stored pixels as the library
+  void setBrightness(uint8_t b) {
+    uint8_t newBrightness = b + 1;
+
+    if (newBrightness != brightness) {
+      uint8_t oldBrightness = brightness - 1;
+      uint16_t scale;
+
+      if (oldBrightness == 0) {
+        scale = 0;
+      } else if (b == 255) {
+        scale = 65535 / oldBrightness;
+      } else {
+        scale = (((uint16_t)newBrightness << 8) - 1) / oldBrightness;
+      }
+
+      for (uint16_t i = 0; i < 3 * numLEDs; i++) {
+        pixels[i] = (pixels[i] * scale) >> 8;
+      }
+
+      brightness = newBrightness;
+      rescales++;
+    }
+  }
+
+  uint8_t getBrightness() const { return brightness - 1; }
+
+  // Color sent to the strip (after brightness scaling)
+  uint32_t getShownColor(uint16_t n) const {
+    return ((uint32_t)pixels[3 * n] << 16) | ((uint32_t)pixels[3 * n + 1] << 8) | pixels[3 * n + 2];
+  }
+
+  uint32_t getShowCount() const { return shows; }
+  uint32_t getRescaleCount() const { return rescales; }
+
+  static uint8_t gamma8(uint8_t x) {
+    static uint8_t table[256];
+    static bool ready = false;
+
+    if (!ready) {
+      for (int i = 0; i < 256; i++) {
+        table[i] = (uint8_t)(__builtin_pow(i / 255.0, 2.6) * 255.0 + 0.5);
+      }
+      ready = true;
+    }
+
+    return table[x];
+  }
+
+  static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255) {
+    uint8_t r, g, b;
+
+    hue = (hue * 1530L + 32768) / 65536;
+
+    if (hue < 510) {
+      b = 0;
+      if (hue < 255) { r = 255; g = hue; } else { r = 510 - hue; g = 255; }
+    } else if (hue < 1020) {
+      r = 0;
+      if (hue < 765) { g = 255; b = hue - 510; } else { g = 1020 - hue; b = 255; }
+    } else if (hue < 1530) {
+      g = 0;
+      if (hue < 1275) { r = hue - 1020; b = 255; } else { r = 255; b = 1530 - hue; }
+    } else {
+      r = 255; g = b = 0;
+    }
+
+    uint32_t v1 = 1 + val;
+    uint16_t s1 = 1 + sat;
+    uint8_t s2 = 255 - sat;
+
+    return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) |
+           (((((g * s1) >> 8) + s2) * v1) & 0xff00) |
+           (((((b * s1) >> 8) + s2) * v1) >> 8);
+  }
+
+private:
+  uint16_t numLEDs;
+  uint8_t brightness;
+  uint8_t *pixels;
+  uint32_t shows;
+  uint32_t rescales;
+};
+
+#endif // _ADAFRUIT_NEOPIXEL_STUB_H
@@ -0,0 +1,43 @@
+// Host build stand-in for the Arduino core (registers are plain variables, time is simulated)
+#ifndef _ARDUINO_STUB_H
+#define _ARDUINO_STUB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/io.h>
+
+#define F_CPU 16000000UL
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+
+#define ISR(vector) void vector()
+
+inline void cli() {}
+inline void sei() {}
+
+// Simulated time, moved forward by delay() or by the test itself
+inline uint32_t stubMicros = 0;
+
+inline uint32_t micros() { return stubMicros; }
+inline uint32_t millis() { return stubMicros / 1000; }
+inline void delay(uint32_t ms) { stubMicros += ms * 1000; }
+
+class __FlashStringHelper;
+#define F(string) (reinterpret_cast<const __FlashStringHelper *>(string))
+
+// Serial output is dropped
+class StubSerial {
+public:
+  void begin(unsigned long) {}
+  template <typename T> void print(T) {}
+  template <typename T> void println(T) {}
+};
+
+inline StubSerial Serial;
+
+#endif // _ARDUINO_STUB_H
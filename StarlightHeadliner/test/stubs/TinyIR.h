@@ -0,0 +1,40 @@
+// Host build stand-in for the TinyIR NEC definitions used by adaptedTinyIRReceiver.hpp
+#ifndef _TINY_IR_STUB_H
+#define _TINY_IR_STUB_H
+
+#include <stdint.h>
+
+#define TINY_RECEIVER_BITS 32
+#define TINY_RECEIVER_UNIT 560
+#define TINY_RECEIVER_HEADER_MARK (16 * TINY_RECEIVER_UNIT)
+#define TINY_RECEIVER_HEADER_SPACE (8 * TINY_RECEIVER_UNIT)
+#define TINY_RECEIVER_BIT_MARK TINY_RECEIVER_UNIT
+#define TINY_RECEIVER_ONE_SPACE (3 * TINY_RECEIVER_UNIT)
+#define TINY_RECEIVER_ZERO_SPACE TINY_RECEIVER_UNIT
+
+#define lowerValue25Percent(value) ((value) * 3 / 4)
+#define upperValue25Percent(value) ((value) * 5 / 4)
+#define lowerValue50Percent(value) ((value) / 2)
+#define upperValue50Percent(value) ((value) * 3 / 2)
+
+#define IR_RECEIVER_STATE_WAITING_FOR_START_MARK 0
+#define IR_RECEIVER_STATE_WAITING_FOR_START_SPACE 1
+#define IR_RECEIVER_STATE_WAITING_FOR_FIRST_DATA_MARK 2
+#define IR_RECEIVER_STATE_WAITING_FOR_DATA_SPACE 3
+#define IR_RECEIVER_STATE_WAITING_FOR_DATA_MARK 4
+
+#define IRDATA_FLAGS_EMPTY 0x00
+
+struct TinyIRReceiverStruct {
+  uint32_t LastChangeMicros;
+  uint8_t IRReceiverState;
+  uint8_t IRRawDataBitCounter;
+  uint32_t IRRawDataMask;
+  union {
+    uint32_t ULong;
+    uint8_t UBytes[4];
+  } IRRawData;
+  uint8_t Flags;
+};
+
+#endif // _TINY_IR_STUB_H
@@ -0,0 +1,22 @@
+// Host build stand-in for the EEPROM (starts blank, writes complete instantly)
+#ifndef _AVR_EEPROM_STUB_H
+#define _AVR_EEPROM_STUB_H
+
+#include <stdint.h>
+#include <string.h>
+#include <avr/io.h>
+
+struct StubEeprom {
+  uint8_t bytes[E2END + 1];
+
+  StubEeprom() { memset(bytes, 0xFF, sizeof(bytes)); }
+};
+
+inline StubEeprom stubEeprom;
+
+inline bool eeprom_is_ready() { return true; }
+inline uint8_t eeprom_read_byte(const uint8_t *address) { return stubEeprom.bytes[(uintptr_t)address]; }
+inline void eeprom_update_byte(uint8_t *address, uint8_t value) { stubEeprom.bytes[(uintptr_t)address] = value; }
+inline void eeprom_read_block(void *dst, const void *address, size_t size) { memcpy(dst, stubEeprom.bytes + (uintptr_t)address, size); }
+
+#endif // _AVR_EEPROM_STUB_H
@@ -0,0 +1,38 @@
+// Host build stand-in for the ATmega328P registers used by the sketch
+#ifndef _AVR_IO_STUB_H
+#define _AVR_IO_STUB_H
+
+#include <stdint.h>
+
+inline volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TCCR2A, TCCR2B, TCNT2, TIMSK2;
+inline volatile uint16_t TCNT1, OCR1A, OCR1B;
+inline volatile uint8_t ADCSRA, ADCSRB, ADMUX, ADCH;
+inline volatile uint8_t EICRA, EIMSK, DDRD, PORTD;
+
+#define OCIE1A 1
+#define OCIE1B 2
+#define WGM12 3
+#define CS12 2
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define TOIE2 0
+#define ADEN 7
+#define ADSC 6
+#define ADIE 3
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define REFS0 6
+#define REFS1 7
+#define ADLAR 5
+#define ISC00 0
+#define ISC11 3
+#define INT0 0
+#define INT1 1
+#define PD3 3
+#define PD4 4
+
+#define E2END 1023
+
+#endif // _AVR_IO_STUB_H
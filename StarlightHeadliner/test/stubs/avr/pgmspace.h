@@ -0,0 +1,11 @@
+// Host build stand-in for program memory access
+#ifndef _AVR_PGMSPACE_STUB_H
+#define _AVR_PGMSPACE_STUB_H
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+
+#endif // _AVR_PGMSPACE_STUB_H
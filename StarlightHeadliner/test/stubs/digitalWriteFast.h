@@ -0,0 +1,8 @@
+// Host build stand-in for digitalWriteFast (IR pin reads idle high)
+#ifndef _DIGITAL_WRITE_FAST_STUB_H
+#define _DIGITAL_WRITE_FAST_STUB_H
+
+#define pinModeFast(pin, mode)
+#define digitalReadFast(pin) HIGH
+
+#endif // _DIGITAL_WRITE_FAST_STUB_H
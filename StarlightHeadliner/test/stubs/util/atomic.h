@@ -0,0 +1,8 @@
+// Host build stand-in for avr-libc atomic blocks (the host build has no interrupts)
+#ifndef _UTIL_ATOMIC_STUB_H
+#define _UTIL_ATOMIC_STUB_H
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_BLOCK(type) for (bool _atomicDone = false; !_atomicDone; _atomicDone = true)
+
+#endif // _UTIL_ATOMIC_STUB_H
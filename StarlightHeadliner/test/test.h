@@ -0,0 +1,33 @@
+// Minimal test helpers for the host build
+#ifndef _TEST_H
+#define _TEST_H
+
+#include <stdio.h>
+
+inline int testFailures = 0;
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      testFailures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQUAL(expected, actual) \
+  do { \
+    long _expected = (expected), _actual = (actual); \
+    if (_expected != _actual) { \
+      printf("%s:%d: expected %s == %ld, got %ld\n", __FILE__, __LINE__, #actual, _expected, _actual); \
+      testFailures++; \
+    } \
+  } while (0)
+
+#define RUN_TEST(test) \
+  do { \
+    int _before = testFailures; \
+    test(); \
+    printf("%s %s\n", (testFailures == _before) ? "PASS" : "FAIL", #test); \
+  } while (0)
+
+#endif // _TEST_H
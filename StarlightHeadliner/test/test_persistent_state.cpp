@@ -0,0 +1,147 @@
+// Host tests for the wear-leveled EEPROM state log
+#include "test.h"
+#include "ConstantsAndTypes.h"
+#include "PersistentState.h"
+#include "LightMode.h"
+#include "ISRsTimersADC.h"
+
+void set_initial_values();
+
+// Blank EEPROM and a writer pointing at it
+void erase_eeprom() {
+  memset(stubEeprom.bytes, 0xFF, sizeof(stubEeprom.bytes));
+  restore_state();
+}
+
+// Lets the quiet period pass and drives the writer until the record is committed
+void save_now() {
+  stubMicros += (SAVE_QUIET_PERIOD + 1) * 1000UL;
+
+  for (uint8_t i = 0; i < 2 * sizeof(savedState_t); i++) {
+    save_state_step();
+  }
+  CHECK(!stateStore.writing);
+}
+
+// Saves a record holding the given hue
+void save_hue(uint16_t hue) {
+  lightMode.currMode = TWINKLE;
+  wideStripParams.hue = hue;
+  mark_state_changed();
+  save_now();
+}
+
+void test_blank_eeprom_uses_default() {
+  memset(stubEeprom.bytes, 0xFF, sizeof(stubEeprom.bytes));
+  CHECK(!restore_state());
+
+  set_initial_values();
+  CHECK_EQUAL(IR_7, command);
+  CHECK(lightMode.modeChange);
+  CHECK_EQUAL(TWINKLE, lightMode.currMode);
+}
+
+void test_restore_after_ring_and_seq_wrap() {
+  erase_eeprom();
+
+  for (uint16_t i = 1; i <= 300; i++) {
+    save_hue(i);
+
+    // Past the ring size and past the 8 bit sequence number
+    if (i == 70 || i == 300) {
+      wideStripParams.hue = 0;
+      CHECK(restore_state());
+      CHECK_EQUAL(i, wideStripParams.hue);
+      CHECK_EQUAL(i % STATE_LOG_SLOTS, stateStore.slot);
+    }
+  }
+}
+
+void test_torn_write_restores_previous() {
+  erase_eeprom();
+  save_hue(1000);
+  save_hue(2000);
+
+  // Start a third record but stop right before its sequence number
+  wideStripParams.hue = 3000;
+  mark_state_changed();
+  stubMicros += (SAVE_QUIET_PERIOD + 1) * 1000UL;
+  save_state_step();
+  while (stateStore.writePos < offsetof(savedState_t, seq)) {
+    save_state_step();
+  }
+  CHECK(stateStore.writing);
+
+  wideStripParams.hue = 0;
+  CHECK(restore_state());
+  CHECK_EQUAL(2000, wideStripParams.hue);
+
+  // Next record goes in the slot of the torn one
+  uint8_t slot = stateStore.slot;
+  save_hue(4000);
+  CHECK_EQUAL((slot + 1) % STATE_LOG_SLOTS, stateStore.slot);
+  CHECK(restore_state());
+  CHECK_EQUAL(4000, wideStripParams.hue);
+}
+
+void test_changes_are_coalesced() {
+  erase_eeprom();
+  uint8_t slot = stateStore.slot;
+
+  for (uint8_t i = 0; i < 5; i++) {
+    wideStripParams.hue = 100 * i;
+    mark_state_changed();
+    stubMicros += (SAVE_QUIET_PERIOD / 2) * 1000UL;
+    save_state_step();
+    CHECK(!stateStore.writing);
+  }
+
+  save_now();
+  CHECK_EQUAL((slot + 1) % STATE_LOG_SLOTS, stateStore.slot);
+  CHECK(restore_state());
+  CHECK_EQUAL(400, wideStripParams.hue);
+}
+
+void test_unchanged_state_is_not_written() {
+  erase_eeprom();
+  save_hue(500);
+
+  uint8_t slot = stateStore.slot;
+  uint8_t before[E2END + 1];
+  memcpy(before, stubEeprom.bytes, sizeof(before));
+
+  mark_state_changed();
+  save_now();
+  CHECK_EQUAL(slot, stateStore.slot);
+  CHECK(memcmp(before, stubEeprom.bytes, sizeof(before)) == 0);
+}
+
+void test_music_restores_saved_brightness() {
+  erase_eeprom();
+
+  // Brightness is driven by the ADC in music mode, the saved one is restored when leaving it
+  lightMode.currMode = MUSIC;
+  wideStripParams.brightness = 30;
+  wideStripParams.brightness_save = 120;
+  narrowStripParams.brightness = 40;
+  narrowStripParams.brightness_save = 130;
+  mark_state_changed();
+  save_now();
+
+  set_initial_values();
+  CHECK_EQUAL(MUSIC, lightMode.currMode);
+  CHECK(!lightMode.modeChange);
+  CHECK_EQUAL(120, wideStripParams.brightness_save);
+  CHECK_EQUAL(130, narrowStripParams.brightness_save);
+}
+
+int main() {
+  RUN_TEST(test_blank_eeprom_uses_default);
+  RUN_TEST(test_restore_after_ring_and_seq_wrap);
+  RUN_TEST(test_torn_write_restores_previous);
+  RUN_TEST(test_changes_are_coalesced);
+  RUN_TEST(test_unchanged_state_is_not_written);
+  RUN_TEST(test_music_restores_saved_brightness);
+
+  return testFailures ? 1 : 0;
+}
@@ -0,0 +1,203 @@
+// Host tests for the incremental current estimate and the brightness limiter
+#include "test.h"
+#include "ConstantsAndTypes.h"
+#include "PowerLimiter.h"
+#include "LightMode.h"
+#include "ISRsTimersADC.h"
+
+void set_initial_values();
+void decode_command();
+void execute_mode();
+
+const uint32_t WHITE = 0xFFFFFF;
+const uint32_t RED = 0xFF0000;
+
+// Level of every pixel read back from the strip buffer (colors are unscaled at full brightness)
+uint16_t rescan_level(const Adafruit_NeoPixel &pixels) {
+  uint16_t sum = 0;
+
+  for (uint8_t i = 0; i < NUM_PIXELS; i++) {
+    uint32_t color = pixels.getShownColor(i);
+    sum += (uint8_t)(color >> 16) + (uint8_t)(color >> 8) + (uint8_t)color;
+  }
+
+  return sum;
+}
+
+// Writes one frame of a single color on both strips and applies the limit
+void render_frame(uint32_t color, uint8_t brightness) {
+  for (uint8_t i = 0; i < NUM_PIXELS; i++) {
+    set_pixel(pixelsWide, wideStripCurrent, i, color);
+    set_pixel(pixelsNarrow, narrowStripCurrent, i, color);
+  }
+
+  apply_power_limit(brightness, brightness);
+}
+
+// Current drawn by what the strips actually show
+uint16_t shown_current() {
+  return estimate_current(wideStripCurrent, pixelsWide.getBrightness()) +
+         estimate_current(narrowStripCurrent, pixelsNarrow.getBrightness());
+}
+
+void test_level_sum_matches_rescan() {
+  uint32_t seed = 12345;
+
+  setup_power_limiter();
+
+  for (uint16_t step = 0; step < 2000; step++) {
+    seed = seed * 1103515245 + 12345;
+
+    if (step % 97 == 0) {
+      clear_pixels(pixelsWide, wideStripCurrent);
+    } else {
+      set_pixel(pixelsWide, wideStripCurrent, (seed >> 8) % NUM_PIXELS, seed >> 4 & 0xFFFFFF);
+    }
+
+    CHECK_EQUAL(rescan_level(pixelsWide), wideStripCurrent.levelSum);
+  }
+}
+
+void test_known_estimates() {
+  setup_power_limiter();
+  CHECK_EQUAL(NUM_PIXELS * LED_IDLE_MA, estimate_current(wideStripCurrent, MAX_BRIGHTNESS));
+
+  for (uint8_t i = 0; i < NUM_PIXELS; i++) {
+    set_pixel(pixelsWide, wideStripCurrent, i, WHITE);
+  }
+  CHECK_EQUAL(418, estimate_current(wideStripCurrent, MAX_BRIGHTNESS));
+  CHECK_EQUAL(59, estimate_current(wideStripCurrent, 31));
+
+  for (uint8_t i = 0; i < NUM_PIXELS; i++) {
+    set_pixel(pixelsWide, wideStripCurrent, i, RED);
+  }
+  CHECK_EQUAL(144, estimate_current(wideStripCurrent, MAX_BRIGHTNESS));
+}
+
+void test_limit_converges() {
+  uint8_t prevScale = POWER_SCALE_NONE;
+  uint8_t frames = 0;
+
+  setup_power_limiter();
+
+  do {
+    render_frame(WHITE, MAX_BRIGHTNESS);
+    CHECK(powerLimiter.scale <= prevScale);
+    prevScale = powerLimiter.scale;
+  } while (!power_limit_settled() && ++frames < 20);
+
+  CHECK(power_limit_settled());
+  CHECK(frames < 10);
+  CHECK(shown_current() <= MAX_CURRENT_MA);
+  CHECK(shown_current() > MAX_CURRENT_MA - 10);
+}
+
+void test_limit_recovers() {
+  uint8_t frames = 0;
+
+  setup_power_limiter();
+
+  while (!power_limit_settled() || frames == 0) {
+    render_frame(WHITE, MAX_BRIGHTNESS);
+    frames++;
+  }
+
+  // Red is under budget, scale goes back up in small steps
+  frames = 0;
+
+  do {
+    uint8_t prevScale = powerLimiter.scale;
+
+    render_frame(RED, MAX_BRIGHTNESS);
+    CHECK(powerLimiter.scale >= prevScale);
+    CHECK(powerLimiter.scale - prevScale <= POWER_SCALE_UP_STEP);
+  } while (!power_limit_settled() && ++frames < 255);
+
+  CHECK_EQUAL(POWER_SCALE_NONE, powerLimiter.scale);
+  CHECK_EQUAL(MAX_BRIGHTNESS, pixelsWide.getBrightness());
+}
+
+// Buffers are only rescaled when the limited brightness changes
+void test_steady_frame_does_not_rescale() {
+  uint8_t frames = 0;
+
+  setup_power_limiter();
+
+  while ((!power_limit_settled() || frames == 0) && frames < 20) {
+    render_frame(WHITE, MAX_BRIGHTNESS);
+    frames++;
+  }
+
+  uint32_t rescales = pixelsWide.getRescaleCount() + pixelsNarrow.getRescaleCount();
+
+  for (uint8_t i = 0; i < 10; i++) {
+    render_frame(WHITE, MAX_BRIGHTNESS);
+  }
+
+  CHECK_EQUAL(rescales, pixelsWide.getRescaleCount() + pixelsNarrow.getRescaleCount());
+  CHECK(power_limit_settled());
+}
+
+// Runs static mode until it turns into blank state
+void render_static() {
+  lightMode.currMode = STATIC;
+  for (uint8_t i = 0; i < 50 && lightMode.currMode != NOTHING; i++) {
+    execute_mode();
+  }
+  CHECK_EQUAL(NOTHING, lightMode.currMode);
+}
+
+// A brightness change is written again at the new brightness instead of keeping the lossy rescale
+void test_static_after_dark() {
+  setup_power_limiter();
+  set_initial_values();
+
+  command = IR_2;
+  decode_command();
+  wideStripParams.brightness = MIN_BRIGHTNESS;
+  narrowStripParams.brightness = MIN_BRIGHTNESS;
+  render_static();
+  CHECK_EQUAL(0, pixelsWide.getShownColor(0));
+
+  wideStripParams.brightness = 100;
+  narrowStripParams.brightness = 100;
+  render_static();
+  CHECK_EQUAL(100, pixelsWide.getBrightness());
+  CHECK_EQUAL((uint32_t)(255 * 101 >> 8) << 16, pixelsWide.getShownColor(0));
+}
+
+// Static mode must not stop rendering on a limit computed from the previous colors
+void test_static_white_after_red() {
+  setup_power_limiter();
+  set_initial_values();
+
+  command = IR_2;
+  decode_command();
+  for (uint8_t i = 0; i < 50 && lightMode.currMode != NOTHING; i++) {
+    execute_mode();
+  }
+  CHECK_EQUAL(NOTHING, lightMode.currMode);
+
+  command = IR_1;
+  decode_command();
+  for (uint8_t i = 0; i < 50 && lightMode.currMode != NOTHING; i++) {
+    execute_mode();
+  }
+  CHECK_EQUAL(NOTHING, lightMode.currMode);
+
+  CHECK_EQUAL(3 * 255 * NUM_PIXELS, wideStripCurrent.levelSum);
+  CHECK(shown_current() <= MAX_CURRENT_MA);
+  CHECK_EQUAL(MAX_BRIGHTNESS, wideStripParams.brightness);
+}
+
+int main() {
+  RUN_TEST(test_level_sum_matches_rescan);
+  RUN_TEST(test_known_estimates);
+  RUN_TEST(test_limit_converges);
+  RUN_TEST(test_limit_recovers);
+  RUN_TEST(test_static_white_after_red);
+  RUN_TEST(test_steady_frame_does_not_rescale);
+  RUN_TEST(test_static_after_dark);
+
+  return testFailures ? 1 : 0;
+}
@@ -0,0 +1,50 @@
+#!/bin/sh
+# Reports per-symbol flash and SRAM usage of the sketch and fails when a budget is exceeded
+#
+#   tools/footprint.sh                    compile with arduino-cli, then report
+#   tools/footprint.sh path/to/sketch.elf report on an ELF exported by the IDE
+#
+# Environment: FLASH_BUDGET, SRAM_BUDGET (bytes), FQBN (board), BUILD_DIR, TOP (symbols listed)
+# The default budgets are unmeasured estimates, set them from the totals of a real build.
+# SRAM is the static part (.data + .bss); NeoPixel buffers (3 * NUM_PIXELS per strip) and the stack come on top.
+
+set -eu
+
+FLASH_BUDGET=${FLASH_BUDGET:-20480}
+SRAM_BUDGET=${SRAM_BUDGET:-1024}
+FQBN=${FQBN:-arduino:avr:nano}
+TOP=${TOP:-15}
+
+SKETCH_DIR=$(cd "$(dirname "$0")/.." && pwd)
+
+if [ $# -ge 1 ]; then
+  ELF=$1
+else
+  BUILD_DIR=${BUILD_DIR:-$SKETCH_DIR/build}
+  arduino-cli compile --fqbn "$FQBN" --output-dir "$BUILD_DIR" "$SKETCH_DIR" > /dev/null
+  ELF=$BUILD_DIR/$(basename "$SKETCH_DIR").ino.elf
+fi
+
+# Symbols as "size type name", sizes in decimal
+SYMBOLS=$(avr-nm -S --size-sort -C -t d "$ELF")
+
+echo "Flash symbols (largest $TOP):"
+echo "$SYMBOLS" | awk '$3 ~ /^[tTrRwW]$/ { name = $0; sub(/^[^ ]+ [^ ]+ [^ ]+ /, "", name); printf "%8d %s\n", $2, name }' | tail -n "$TOP"
+
+echo "SRAM symbols (largest $TOP):"
+echo "$SYMBOLS" | awk '$3 ~ /^[dDbB]$/ { name = $0; sub(/^[^ ]+ [^ ]+ [^ ]+ /, "", name); printf "%8d %s\n", $2, name }' | tail -n "$TOP"
+
+# Section totals (flash holds .text and the .data initializers)
+eval "$(avr-size -A "$ELF" | awk '
+  $1 == ".text" { text = $2 }
+  $1 == ".data" { data = $2 }
+  $1 == ".bss" { bss = $2 }
+  END { printf "FLASH=%d SRAM=%d\n", text + data, data + bss }')"
+
+echo "Flash: $FLASH bytes (budget $FLASH_BUDGET)"
+echo "SRAM:  $SRAM bytes (budget $SRAM_BUDGET)"
+
+if [ "$FLASH" -gt "$FLASH_BUDGET" ] || [ "$SRAM" -gt "$SRAM_BUDGET" ]; then
+  echo "Footprint budget exceeded"
+  exit 1
+fi